@@ -0,0 +1,212 @@
+// Host simulation of caller admission control on the single SIM800 line.
+// Drives the firmware's Admission.cpp with synthetic arrival patterns and
+// compares calls-per-hour with admission control off and on.
+//
+//   g++ -std=c++17 -I../include admission_sim.cpp ../src/Admission.cpp -o admission_sim
+//   ./admission_sim [hours] [seed]
+#include "Admission.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <queue>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Line time per outcome, in seconds
+const uint32_t DROPPED_CALL_S = 10; // storming caller hangs up during the greeting
+const uint32_t FAST_REJECT_S = 2;   // CLIP + ATH
+const uint32_t PROMPT_S = 8;        // answer + "already issued" + ATH
+const uint32_t RING_RECHECK_S = 3;  // SIM800 repeats RING roughly this often
+
+struct Scenario {
+	const char *name;
+	double callersPerHour;    // new customers
+	double anxiousRedial;     // chance a served caller calls again "to check"
+	uint32_t callSeconds;     // greeting + ID + service menu + readback
+	bool storm;               // one number redialling every 40 s for 30 min
+	bool stormDrops;          // ...and hanging up before a token is issued
+	bool outage;              // backend down from minute 60 to 80
+	uint16_t maxCallsPerHour; // rate budget for the "on" run (default config is unlimited)
+};
+
+const char *STORM_NUMBER = "0799999999";
+
+struct Arrival {
+	uint32_t at;
+	std::string number;
+	bool operator>(const Arrival &o) const { return at > o.at; }
+};
+
+struct Result {
+	uint32_t attempts = 0;
+	uint32_t answered = 0;        // full IVR calls
+	uint32_t tokens = 0;
+	uint32_t duplicateTokens = 0;
+	uint32_t busyLost = 0;        // line already in use
+	uint32_t uniqueServed = 0;
+	uint32_t lineSeconds = 0;
+	AdmissionStats stats;
+};
+
+AdmissionConfig disabledConfig() {
+	AdmissionConfig cfg;
+	cfg.issuedWindowMs = 0;
+	cfg.stormMaxAttempts = 0;
+	cfg.maxCallsPerHour = 0;
+	cfg.backendFailLimit = 0;
+	return cfg;
+}
+
+Result run(const Scenario &sc, const AdmissionConfig &cfg, uint32_t hours, unsigned seed) {
+	std::mt19937 rng(seed);
+	std::uniform_real_distribution<double> uni(0.0, 1.0);
+	std::exponential_distribution<double> gap(sc.callersPerHour / 3600.0);
+	std::priority_queue<Arrival, std::vector<Arrival>, std::greater<Arrival>> arrivals;
+	const uint32_t end = hours * 3600;
+
+	uint32_t t = 0;
+	for (int n = 0; (t += (uint32_t)gap(rng) + 1) < end; ++n) {
+		arrivals.push({t, "07" + std::to_string(10000000 + n)});
+	}
+	if (sc.storm) {
+		for (uint32_t s = 1800; s < 1800 + 1800 && s < end; s += 40) arrivals.push({s, STORM_NUMBER});
+	}
+
+	admissionBegin(cfg);
+	Result r;
+	std::set<std::string> served;
+	uint32_t busyUntil = 0;
+	// Call in progress: finishes at busyUntil with or without a token
+	bool inCall = false;
+	bool inCallDrops = false;
+	std::string inCallNumber;
+	// Caller left ringing by ADMIT_QUEUE
+	bool ringing = false;
+	std::string ringingNumber;
+	uint32_t nextRing = 0;
+
+	auto redial = [&](const std::string &number, uint32_t now, double p, uint32_t minS, uint32_t maxS) {
+		if (uni(rng) >= p) return;
+		std::uniform_int_distribution<uint32_t> d(minS, maxS);
+		arrivals.push({now + d(rng), number});
+	};
+	auto occupy = [&](uint32_t now, uint32_t secs) {
+		busyUntil = now + secs;
+		r.lineSeconds += secs;
+	};
+	// Act on a decision for a caller the line is free to handle
+	auto handle = [&](const std::string &number, uint32_t now, AdmitDecision d, AdmitReason why) {
+		switch (d) {
+			case ADMIT_ACCEPT:
+				++r.answered;
+				inCall = true;
+				inCallNumber = number;
+				inCallDrops = sc.stormDrops && number == STORM_NUMBER;
+				occupy(now, inCallDrops ? DROPPED_CALL_S : sc.callSeconds);
+				break;
+			case ADMIT_QUEUE:
+				ringing = true;
+				ringingNumber = number;
+				nextRing = now + RING_RECHECK_S;
+				break;
+			case ADMIT_PROMPT:
+				occupy(now, PROMPT_S);
+				if (why != ADMIT_REASON_DUPLICATE) redial(number, now, 0.5, 300, 900);
+				break;
+			case ADMIT_REJECT:
+				occupy(now, FAST_REJECT_S);
+				if (why != ADMIT_REASON_DUPLICATE && why != ADMIT_REASON_STORM) redial(number, now, 0.7, 60, 300);
+				break;
+		}
+	};
+
+	for (uint32_t now = 0; now < end; ++now) {
+		uint32_t nowMs = now * 1000;
+		if (inCall && now >= busyUntil) {
+			inCall = false;
+			if (inCallDrops) continue;
+			bool backendUp = !(sc.outage && now >= 3600 && now < 4800);
+			admissionBackendResult(backendUp, nowMs);
+			if (backendUp) {
+				++r.tokens;
+				if (!served.insert(inCallNumber).second) ++r.duplicateTokens;
+				admissionTokenIssued(inCallNumber.c_str(), nowMs);
+				redial(inCallNumber, now, sc.anxiousRedial, 120, 900);
+			} else {
+				redial(inCallNumber, now, 0.8, 60, 300);
+			}
+		}
+		if (ringing && now >= busyUntil && now >= nextRing) {
+			AdmitReason why;
+			AdmitDecision d = admissionCheck(ringingNumber.c_str(), nowMs, &why);
+			if (d == ADMIT_QUEUE) {
+				nextRing = now + RING_RECHECK_S;
+			} else {
+				ringing = false;
+				handle(ringingNumber, now, d, why);
+			}
+		}
+		while (!arrivals.empty() && arrivals.top().at <= now) {
+			Arrival a = arrivals.top();
+			arrivals.pop();
+			++r.attempts;
+			if (inCall || ringing || now < busyUntil) {
+				++r.busyLost;
+				redial(a.number, now, 0.7, 30, 120);
+				continue;
+			}
+			AdmitReason why;
+			AdmitDecision d = admissionCheck(a.number.c_str(), nowMs, &why);
+			handle(a.number, now, d, why);
+		}
+	}
+	r.uniqueServed = served.size();
+	r.stats = admissionStats();
+	return r;
+}
+
+void print(const char *label, const Result &r, uint32_t hours) {
+	printf("  %-4s attempts/h %6.1f  answered/h %5.1f  unique/h %5.1f  dup tokens %3u  busy %4u  line %3.0f%%\n",
+	       label, r.attempts / (double)hours, r.answered / (double)hours, r.uniqueServed / (double)hours,
+	       r.duplicateTokens, r.busyLost, 100.0 * r.lineSeconds / (hours * 3600.0));
+	const AdmissionStats &st = r.stats;
+	printf("       decisions: accept %u  reject dup %u storm %u rate %u backend %u"
+	       "  (prompted %u)  queued %u (timeout %u)\n",
+	       st.accepted, st.rejectedDuplicate, st.rejectedStorm, st.rejectedRate, st.rejectedBackend,
+	       st.prompted, st.queued, st.queueTimeouts);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	uint32_t hours = argc > 1 ? (uint32_t)atoi(argv[1]) : 3;
+	unsigned seed = argc > 2 ? (unsigned)atoi(argv[2]) : 1;
+	if (hours == 0) hours = 1;
+	const Scenario scenarios[] = {
+		{"steady", 25, 0.10, 75, false, false, false, 0},
+		{"peak", 45, 0.25, 75, false, false, false, 0},
+		// Storming number gets a token on its first call: caught as duplicate
+		{"peak+storm", 45, 0.25, 75, true, false, false, 0},
+		// Storming number never completes a call: caught by the storm limit
+		{"peak+drop-storm", 45, 0.25, 75, true, true, false, 0},
+		// Short calls, default (unlimited) budget vs. a 40/h budget: the rate
+		// limit caps calls below what the line could carry
+		{"rush", 70, 0.10, 30, false, false, false, 0},
+		{"rush+budget", 70, 0.10, 30, false, false, false, 40},
+		{"peak+outage", 45, 0.25, 75, false, false, true, 0},
+	};
+	for (const Scenario &sc : scenarios) {
+		AdmissionConfig on;
+		on.maxCallsPerHour = sc.maxCallsPerHour;
+		printf("%s (%.0f new callers/h, %u h", sc.name, sc.callersPerHour, hours);
+		if (sc.maxCallsPerHour) printf(", budget %u/h", sc.maxCallsPerHour);
+		printf(")\n");
+		print("off", run(sc, disabledConfig(), hours, seed), hours);
+		print("on", run(sc, on, hours, seed), hours);
+	}
+	return 0;
+}
@@ -0,0 +1,69 @@
+// Host-side stand-in for the prompts partition: maps an image built by
+// scripts/mkprompts.py through the same PromptPartition code the firmware uses
+// and prints what the device would see.
+//
+//   g++ -std=c++17 -I../include prompt_host.cpp ../src/PromptPartition.cpp -o prompt_host
+//   ./prompt_host prompts.bin                      list prompts and WAV formats
+//   ./prompt_host prompts.bin /audio_files/1.wav   dump one prompt to stdout
+#include "PromptPartition.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static uint32_t le32(const uint8_t *p) {
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint16_t le16(const uint8_t *p) {
+	return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+// Print the fmt chunk of a mapped WAV, walking chunks the way the decoder does.
+static void describeWav(const uint8_t *data, uint32_t len) {
+	if (len < 12 || memcmp(data, "RIFF", 4) != 0 || memcmp(data + 8, "WAVE", 4) != 0) {
+		printf("not RIFF/WAVE");
+		return;
+	}
+	uint32_t pos = 12;
+	while (pos + 8 <= len) {
+		uint32_t size = le32(data + pos + 4);
+		if (memcmp(data + pos, "fmt ", 4) == 0 && size >= 16 && pos + 8 + 16 <= len) {
+			const uint8_t *f = data + pos + 8;
+			printf("fmt=%u ch=%u rate=%u bits=%u", le16(f), le16(f + 2), le32(f + 4), le16(f + 14));
+			return;
+		}
+		pos += 8 + size + (size & 1);
+	}
+	printf("no fmt chunk");
+}
+
+int main(int argc, char **argv) {
+	if (argc < 2) {
+		fprintf(stderr, "usage: %s IMAGE [PROMPT]\n", argv[0]);
+		return 2;
+	}
+	if (!promptPartitionBegin(argv[1])) {
+		fprintf(stderr, "%s: not a valid prompts image\n", argv[1]);
+		return 1;
+	}
+	if (argc >= 3) {
+		const uint8_t *data;
+		uint32_t len;
+		if (!promptLookup(argv[2], &data, &len)) {
+			fprintf(stderr, "%s: not found\n", argv[2]);
+			return 1;
+		}
+		fwrite(data, 1, len, stdout);
+		return 0;
+	}
+	for (uint32_t i = 0; i < promptCount(); ++i) {
+		const uint8_t *data;
+		uint32_t len;
+		promptLookup(promptName(i), &data, &len);
+		printf("%-48s %8u  ", promptName(i), len);
+		describeWav(data, len);
+		printf("\n");
+	}
+	promptPartitionEnd();
+	return 0;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <stdint.h>
+
+// Caller admission control for incoming calls. Decides, before the call is
+// answered, whether to take it, fast-reject it, answer with a short prompt,
+// or leave it ringing (queued) until capacity frees up.
+//
+// Plain C++ with the clock passed in, so host/admission_sim.cpp can drive it
+// with synthetic arrivals.
+
+enum AdmitPolicy {
+	ADMIT_POLICY_REJECT,  // ATH straight away, caller hears nothing
+	ADMIT_POLICY_PROMPT,  // answer, play a short prompt, hang up
+	ADMIT_POLICY_QUEUE    // don't answer yet; re-check on each RING
+};
+
+enum AdmitDecision {
+	ADMIT_ACCEPT,
+	ADMIT_REJECT,
+	ADMIT_PROMPT,
+	ADMIT_QUEUE
+};
+
+enum AdmitReason {
+	ADMIT_REASON_NONE,
+	ADMIT_REASON_DUPLICATE,  // number already got a token recently
+	ADMIT_REASON_STORM,      // number is redialling too often
+	ADMIT_REASON_RATE,       // over the calls-per-hour budget
+	ADMIT_REASON_BACKEND     // backend failing, shedding load
+};
+
+struct AdmissionConfig {
+	uint32_t issuedWindowMs = 30UL * 60 * 1000;  // duplicate window after a token
+	uint32_t ringIntervalMs = 6000;              // longest gap between RINGs of one queued call
+	uint32_t stormWindowMs = 5UL * 60 * 1000;    // quiet time that ends a redial storm
+	uint8_t stormMaxAttempts = 4;                // attempts with no such gap before rejecting
+	// Calls-per-hour budget, 0 = unlimited. The single line already caps calls
+	// at 3600 / call length, so a lower budget only turns callers away. Set it
+	// when something downstream (counter staff, SMS quota) can't keep up with
+	// what the line delivers.
+	uint16_t maxCallsPerHour = 0;
+	uint8_t rateBurst = 3;
+	uint8_t backendFailLimit = 3;                // consecutive failures before shedding
+	uint32_t backendCooldownMs = 60000;
+	uint32_t queueMaxWaitMs = 30000;             // longest a queued caller is left ringing
+	AdmitPolicy duplicatePolicy = ADMIT_POLICY_PROMPT;
+	AdmitPolicy stormPolicy = ADMIT_POLICY_REJECT;
+	AdmitPolicy overloadPolicy = ADMIT_POLICY_QUEUE;
+};
+
+struct AdmissionStats {
+	uint32_t accepted;
+	uint32_t rejectedDuplicate;
+	uint32_t rejectedStorm;
+	uint32_t rejectedRate;
+	uint32_t rejectedBackend;
+	uint32_t prompted;       // subset of the rejections above answered with a prompt
+	uint32_t queued;         // attempts that waited in the queue at least once
+	uint32_t queueTimeouts;  // queued attempts rejected after queueMaxWaitMs
+	uint32_t tokensIssued;
+};
+
+void admissionBegin(const AdmissionConfig &cfg);
+// Called for every RING with the caller's number (may be empty if CLIP is
+// missing; such calls skip the per-number checks).
+AdmitDecision admissionCheck(const char *number, uint32_t nowMs, AdmitReason *reason = nullptr);
+void admissionTokenIssued(const char *number, uint32_t nowMs);
+void admissionBackendResult(bool ok, uint32_t nowMs);
+const AdmissionStats &admissionStats();
+void admissionResetStats();
+const char *admissionReasonName(AdmitReason reason);
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <AudioFileSource.h>
+#include "PromptPartition.h"
+
+// Presents several WAV prompts as one continuous WAV stream: a single
+// synthesized header followed by the PCM data of every segment back to back.
+// The decoder never sees a clip boundary, so there is no stop/begin gap
+// between clips. All segments must share the first segment's format.
+class AudioFileSourceConcat : public AudioFileSource {
+public:
+	typedef AudioFileSource *(*Opener)(const char *path);
+
+	static const int MAX_SEGMENTS = 64;
+
+	explicit AudioFileSourceConcat(Opener opener);
+	virtual ~AudioFileSourceConcat() override;
+
+	// Probe a prompt and append its data chunk. Returns false (and skips it)
+	// if the prompt is missing, not PCM WAV, or differs in format.
+	bool add(const char *path);
+	int segmentCount() const { return count; }
+	bool full() const { return count >= MAX_SEGMENTS; }
+
+	virtual uint32_t read(void *data, uint32_t len) override;
+	virtual bool seek(int32_t pos, int dir) override;
+	virtual bool close() override;
+	virtual bool isOpen() override;
+	virtual uint32_t getSize() override;
+	virtual uint32_t getPos() override;
+
+private:
+	struct Segment {
+		char path[PROMPT_NAME_LEN];
+		uint32_t dataOffset;
+		uint32_t dataLen;
+	};
+
+	bool openSegment(int index, AudioFileSource **src);
+	void buildHeader();
+
+	Opener opener;
+	Segment segments[MAX_SEGMENTS];
+	int count = 0;
+	uint16_t channels = 0;
+	uint32_t sampleRate = 0;
+	uint16_t bitsPerSample = 0;
+	uint8_t header[44];
+	uint32_t totalData = 0;
+	uint32_t pos = 0;
+	// Current segment being streamed and the next one, opened ahead of time so
+	// an SD open never lands on a clip boundary.
+	int curIndex = -1;
+	uint32_t curRemaining = 0;
+	AudioFileSource *cur = nullptr;
+	AudioFileSource *next = nullptr;
+	bool closed = false;
+};
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Lightweight wall-time profiler for blocking calls and loop stalls.
+//
+// PROF_SCOPE("label") times the rest of the enclosing block; PROF_CALL wraps
+// a single expression and yields its value. Each use site owns a static
+// ProfSite, so the report is per call site even when labels repeat. A record
+// costs two micros() reads and a few adds, cheap enough to leave on in
+// production; build with -DPROFILER_ENABLED=0 to compile it out.
+//
+// profLoopTick() goes in every polling loop. A gap between ticks longer than
+// PROF_STALL_MS is counted as a stall and charged to the longest single
+// recording since the previous tick if that call covers at least half the
+// gap; otherwise it is reported as unattributed (unprofiled code such as
+// wav->loop() or NTP).
+
+#ifndef PROFILER_ENABLED
+#define PROFILER_ENABLED 1
+#endif
+
+#ifndef PROF_STALL_MS
+#define PROF_STALL_MS 250
+#endif
+
+// Log2 histogram buckets: [0] < 128 us, [i] < 128 us << i, last is open ended
+#define PROF_BUCKETS 16
+
+struct ProfSite {
+	const char *name;
+	uint32_t count;
+	uint64_t totalUs;   // self time: nested scopes excluded
+	uint32_t maxUs;
+	uint32_t stalls;
+	uint32_t buckets[PROF_BUCKETS];
+	ProfSite *next;
+	bool registered;
+};
+
+// us is the call's wall time (histogram, max, stalls); selfUs excludes nested scopes
+void profRecord(ProfSite *site, uint32_t us, uint32_t selfUs);
+void profLoopTick();
+void profReport(Print &out, int topN = 10);
+void profReset();
+
+#if PROFILER_ENABLED
+
+// Scopes nest: time spent in an inner scope is subtracted from the outer
+// one's self time. Only use from the loop task; the nesting chain is global.
+class ProfScope {
+public:
+	explicit ProfScope(ProfSite *site);
+	~ProfScope();
+
+private:
+	ProfSite *site;
+	ProfScope *parent;
+	uint32_t start;
+	uint32_t childUs;
+};
+
+#define PROF_CAT_(a, b) a##b
+#define PROF_CAT(a, b) PROF_CAT_(a, b)
+#define PROF_SCOPE(label) \
+	static ProfSite PROF_CAT(profSite_, __LINE__) = {label, 0, 0, 0, 0, {0}, nullptr, false}; \
+	ProfScope PROF_CAT(profScope_, __LINE__)(&PROF_CAT(profSite_, __LINE__))
+#define PROF_CALL(label, expr) ([&]() { PROF_SCOPE(label); return (expr); }())
+#define PROF_LOOP_TICK() profLoopTick()
+
+#else
+
+#define PROF_SCOPE(label) do {} while (0)
+#define PROF_CALL(label, expr) (expr)
+#define PROF_LOOP_TICK() do {} while (0)
+
+#endif
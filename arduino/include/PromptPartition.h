@@ -0,0 +1,32 @@
+#pragma once
+
+#include <stdint.h>
+
+// Read-only view of the "prompts" flash partition built by scripts/mkprompts.py.
+// The partition is memory-mapped once at boot; lookups return pointers straight
+// into the mapped region so prompts can be decoded without copies or file opens.
+//
+// Image layout (little endian):
+//   header  : "PRM1", u32 count, u32 imageSize, u32 reserved
+//   entries : count x { char name[56], u32 offset, u32 length }
+//   data    : WAV files, each 4-byte aligned, offsets relative to image start
+
+#define PROMPT_MAGIC "PRM1"
+#define PROMPT_NAME_LEN 56
+#define PROMPT_PARTITION_LABEL "prompts"
+#define PROMPT_PARTITION_SUBTYPE 0x40
+
+// Map the prompts partition. Returns false (and leaves the SD fallback in place)
+// if the partition is missing, empty or its image fails validation.
+bool promptPartitionBegin();
+#ifndef ARDUINO
+// Host-side stand-in: map an image file produced by mkprompts.py instead of flash.
+bool promptPartitionBegin(const char *imagePath);
+#endif
+void promptPartitionEnd();
+
+bool promptPartitionReady();
+// Find a prompt by its SD-style path, e.g. "/audio_files/1.wav".
+bool promptLookup(const char *path, const uint8_t **data, uint32_t *len);
+uint32_t promptCount();
+const char *promptName(uint32_t index);
@@ -0,0 +1,125 @@
+#!/usr/bin/env python3
+"""Pack prompt WAVs into an image for the "prompts" flash partition.
+
+Files are keyed by their SD-style path relative to --root, so
+data/audio_files/1.wav becomes "/audio_files/1.wav" and the firmware can
+look prompts up with the same paths it passes to playWav().
+
+    python scripts/mkprompts.py --root data --out prompts.bin
+    python scripts/mkprompts.py --list prompts.bin
+
+The layout is documented in include/PromptPartition.h.
+"""
+import argparse
+import csv
+import os
+import struct
+import sys
+
+MAGIC = b"PRM1"
+NAME_LEN = 56
+HEADER = struct.Struct("<4sIII")
+ENTRY = struct.Struct("<%dsII" % NAME_LEN)
+ALIGN = 4
+
+
+def parse_int(text):
+    return int(text.strip(), 0)
+
+
+def find_partition(csv_path, label):
+    """Return (offset, size) of a partition in a partitions.csv table."""
+    with open(csv_path, newline="") as f:
+        for row in csv.reader(f):
+            if not row or row[0].strip().startswith("#"):
+                continue
+            if row[0].strip() == label:
+                return parse_int(row[3]), parse_int(row[4])
+    raise KeyError("partition %r not found in %s" % (label, csv_path))
+
+
+def collect(root):
+    prompts = []
+    for dirpath, _, filenames in os.walk(root):
+        for name in filenames:
+            if not name.lower().endswith(".wav"):
+                continue
+            full = os.path.join(dirpath, name)
+            key = "/" + os.path.relpath(full, root).replace(os.sep, "/")
+            if len(key.encode()) >= NAME_LEN:
+                raise ValueError("prompt path too long (max %d): %s" % (NAME_LEN - 1, key))
+            with open(full, "rb") as f:
+                data = f.read()
+            if data[:4] != b"RIFF" or data[8:12] != b"WAVE":
+                raise ValueError("not a RIFF/WAVE file: %s" % full)
+            prompts.append((key, data))
+    prompts.sort(key=lambda p: p[0])
+    return prompts
+
+
+def build(prompts):
+    table_end = HEADER.size + ENTRY.size * len(prompts)
+    offset = (table_end + ALIGN - 1) & ~(ALIGN - 1)
+    entries = []
+    blobs = bytearray()
+    for key, data in prompts:
+        entries.append(ENTRY.pack(key.encode(), offset, len(data)))
+        pad = (-len(data)) % ALIGN
+        blobs += data + b"\0" * pad
+        offset += len(data) + pad
+    out = bytearray(HEADER.pack(MAGIC, len(prompts), offset, 0))
+    for e in entries:
+        out += e
+    out += b"\0" * ((-len(out)) % ALIGN)
+    out += blobs
+    assert len(out) == offset
+    return bytes(out)
+
+
+def list_image(path):
+    with open(path, "rb") as f:
+        image = f.read()
+    magic, count, size, _ = HEADER.unpack_from(image, 0)
+    if magic != MAGIC:
+        raise ValueError("bad magic in %s" % path)
+    print("%s: %d prompts, %d bytes" % (path, count, size))
+    for i in range(count):
+        name, off, length = ENTRY.unpack_from(image, HEADER.size + i * ENTRY.size)
+        print("  %-48s %8d @ 0x%06x" % (name.rstrip(b"\0").decode(), length, off))
+
+
+def main(argv=None):
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("--root", default="data", help="directory mirroring the SD card layout")
+    ap.add_argument("--out", default="prompts.bin")
+    ap.add_argument("--partitions", help="partitions.csv used to check the image fits")
+    ap.add_argument("--label", default="prompts")
+    ap.add_argument("--list", metavar="IMAGE", help="print the entries of an existing image")
+    args = ap.parse_args(argv)
+
+    if args.list:
+        list_image(args.list)
+        return 0
+
+    prompts = collect(args.root)
+    if not prompts:
+        print("mkprompts: no .wav files under %s" % args.root, file=sys.stderr)
+        return 1
+    image = build(prompts)
+    if args.partitions:
+        _, size = find_partition(args.partitions, args.label)
+        if len(image) > size:
+            print("mkprompts: image is %d bytes, partition %r holds %d"
+                  % (len(image), args.label, size), file=sys.stderr)
+            return 1
+    out_dir = os.path.dirname(args.out)
+    if out_dir:
+        os.makedirs(out_dir, exist_ok=True)
+    with open(args.out, "wb") as f:
+        f.write(image)
+    print("mkprompts: %d prompts, %d bytes -> %s" % (len(prompts), len(image), args.out))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,54 @@
+# PlatformIO extra script: adds "prompts" and "uploadprompts" targets.
+#
+#   pio run -t prompts         build $BUILD_DIR/prompts.bin from data/
+#   pio run -t uploadprompts   build and flash it to the "prompts" partition
+Import("env")
+
+import os
+import sys
+
+sys.path.insert(0, os.path.join(env.subst("$PROJECT_DIR"), "scripts"))
+import mkprompts
+
+PARTITIONS = os.path.join(env.subst("$PROJECT_DIR"), "partitions.csv")
+IMAGE = os.path.join(env.subst("$BUILD_DIR"), "prompts.bin")
+
+
+def build_prompts(source, target, env):
+    rc = mkprompts.main([
+        "--root", env.subst("$PROJECT_DATA_DIR"),
+        "--out", IMAGE,
+        "--partitions", PARTITIONS,
+    ])
+    if rc != 0:
+        env.Exit(rc)
+
+
+def upload_prompts(source, target, env):
+    build_prompts(source, target, env)
+    offset, _ = mkprompts.find_partition(PARTITIONS, "prompts")
+    env.AutodetectUploadPort()
+    env.Execute(" ".join([
+        '"$PYTHONEXE"', '"$UPLOADER"',
+        "--chip", "esp32",
+        "--port", '"$UPLOAD_PORT"',
+        "--baud", "$UPLOAD_SPEED",
+        "write_flash", hex(offset), '"%s"' % IMAGE,
+    ]))
+
+
+env.AddCustomTarget(
+    name="prompts",
+    dependencies=None,
+    actions=[build_prompts],
+    title="Build prompts image",
+    description="Pack data/**/*.wav into the prompts partition image",
+)
+
+env.AddCustomTarget(
+    name="uploadprompts",
+    dependencies=None,
+    actions=[upload_prompts],
+    title="Upload prompts image",
+    description="Flash the prompts image to the prompts partition",
+)
@@ -0,0 +1,207 @@
+#include "Admission.h"
+
+#include <string.h>
+
+namespace {
+
+const int TABLE_SIZE = 32;
+const int NUMBER_LEN = 20;
+const uint32_t MILLI = 1000;  // rate bucket counts thousandths of a call
+
+struct RecentCaller {
+	char number[NUMBER_LEN];
+	uint32_t lastRingMs;
+	uint32_t issuedMs;
+	uint32_t queuedSinceMs;
+	uint8_t attempts;
+	bool issued;
+	bool queued;
+	bool inUse;
+};
+
+AdmissionConfig config;
+AdmissionStats stats;
+RecentCaller table[TABLE_SIZE];
+
+uint32_t bucketMilli = 0;
+uint32_t bucketUpdatedMs = 0;
+uint8_t backendFailures = 0;
+uint32_t backendShedUntilMs = 0;
+bool backendShedding = false;
+
+// Time comparisons use unsigned differences so millis() wrap is harmless
+bool within(uint32_t nowMs, uint32_t sinceMs, uint32_t windowMs) {
+	return nowMs - sinceMs < windowMs;
+}
+
+bool holdsToken(const RecentCaller &c, uint32_t nowMs) {
+	return c.issued && within(nowMs, c.issuedMs, config.issuedWindowMs);
+}
+
+// Eviction preference: free slot, then a number without a live token (least
+// recently heard first), then the live token closest to expiring. Evicting a
+// live token would let that number collect a second one.
+bool betterVictim(const RecentCaller &c, const RecentCaller &slot, uint32_t nowMs) {
+	if (!slot.inUse) return false;
+	if (!c.inUse) return true;
+	bool cHolds = holdsToken(c, nowMs);
+	bool slotHolds = holdsToken(slot, nowMs);
+	if (cHolds != slotHolds) return !cHolds;
+	if (cHolds) return nowMs - c.issuedMs > nowMs - slot.issuedMs;
+	return nowMs - c.lastRingMs > nowMs - slot.lastRingMs;
+}
+
+RecentCaller *findCaller(const char *number, uint32_t nowMs, bool create) {
+	RecentCaller *slot = nullptr;
+	for (int i = 0; i < TABLE_SIZE; ++i) {
+		RecentCaller &c = table[i];
+		if (c.inUse && strncmp(c.number, number, NUMBER_LEN - 1) == 0) return &c;
+		if (!slot || betterVictim(c, *slot, nowMs)) slot = &c;
+	}
+	if (!create) return nullptr;
+	memset(slot, 0, sizeof(*slot));
+	strncpy(slot->number, number, NUMBER_LEN - 1);
+	slot->inUse = true;
+	slot->lastRingMs = nowMs;
+	return slot;
+}
+
+void refillBucket(uint32_t nowMs) {
+	uint32_t cap = (uint32_t)config.rateBurst * MILLI;
+	uint64_t add = (uint64_t)(nowMs - bucketUpdatedMs) * config.maxCallsPerHour / 3600;
+	bucketUpdatedMs = nowMs;
+	bucketMilli = add >= cap - bucketMilli ? cap : bucketMilli + (uint32_t)add;
+}
+
+bool backendOverloaded(uint32_t nowMs) {
+	if (!backendShedding) return false;
+	if ((int32_t)(nowMs - backendShedUntilMs) < 0) return true;
+	// Cooldown over: let calls through again; one more failure re-arms it
+	backendShedding = false;
+	backendFailures = config.backendFailLimit > 0 ? config.backendFailLimit - 1 : 0;
+	return false;
+}
+
+AdmitDecision applyPolicy(AdmitPolicy policy, AdmitReason why, RecentCaller *c, uint32_t nowMs, AdmitReason *reason) {
+	if (reason) *reason = why;
+	if (policy == ADMIT_POLICY_QUEUE && c) {
+		if (!c->queued) {
+			c->queued = true;
+			c->queuedSinceMs = nowMs;
+			++stats.queued;
+			return ADMIT_QUEUE;
+		}
+		if (within(nowMs, c->queuedSinceMs, config.queueMaxWaitMs)) return ADMIT_QUEUE;
+		++stats.queueTimeouts;
+		c->queued = false;
+		policy = ADMIT_POLICY_REJECT;
+	} else if (policy == ADMIT_POLICY_QUEUE) {
+		// Nothing to track a queue position against without a number
+		policy = ADMIT_POLICY_REJECT;
+	}
+	switch (why) {
+		case ADMIT_REASON_DUPLICATE: ++stats.rejectedDuplicate; break;
+		case ADMIT_REASON_STORM: ++stats.rejectedStorm; break;
+		case ADMIT_REASON_RATE: ++stats.rejectedRate; break;
+		case ADMIT_REASON_BACKEND: ++stats.rejectedBackend; break;
+		default: break;
+	}
+	if (policy == ADMIT_POLICY_PROMPT) {
+		++stats.prompted;
+		return ADMIT_PROMPT;
+	}
+	return ADMIT_REJECT;
+}
+
+} // namespace
+
+void admissionBegin(const AdmissionConfig &cfg) {
+	config = cfg;
+	memset(table, 0, sizeof(table));
+	admissionResetStats();
+	bucketMilli = (uint32_t)config.rateBurst * MILLI;
+	bucketUpdatedMs = 0;
+	backendFailures = 0;
+	backendShedding = false;
+}
+
+AdmitDecision admissionCheck(const char *number, uint32_t nowMs, AdmitReason *reason) {
+	if (reason) *reason = ADMIT_REASON_NONE;
+	RecentCaller *c = nullptr;
+	if (number && number[0]) {
+		c = findCaller(number, nowMs, true);
+		// Only a queued call is left ringing; once a call is answered or sent
+		// ATH (queued cleared), or the caller gave up ringing, the next RING
+		// from the number is a new attempt and is judged and counted afresh.
+		bool stillRinging = c->queued && within(nowMs, c->lastRingMs, config.ringIntervalMs);
+		if (!stillRinging) {
+			c->queued = false;
+			// A storm lasts until the number has been quiet for stormWindowMs
+			if (!within(nowMs, c->lastRingMs, config.stormWindowMs)) c->attempts = 0;
+			if (c->attempts < 255) ++c->attempts;
+		}
+		c->lastRingMs = nowMs;
+		// Storm first: a token holder redialling hard gets the fast reject, not
+		// an answered "already issued" prompt that ties up the line each time
+		if (config.stormMaxAttempts && c->attempts > config.stormMaxAttempts) {
+			AdmitPolicy p = config.stormPolicy == ADMIT_POLICY_QUEUE ? ADMIT_POLICY_REJECT : config.stormPolicy;
+			return applyPolicy(p, ADMIT_REASON_STORM, c, nowMs, reason);
+		}
+		if (holdsToken(*c, nowMs)) {
+			AdmitPolicy p = config.duplicatePolicy == ADMIT_POLICY_QUEUE ? ADMIT_POLICY_REJECT : config.duplicatePolicy;
+			return applyPolicy(p, ADMIT_REASON_DUPLICATE, c, nowMs, reason);
+		}
+	}
+	if (backendOverloaded(nowMs)) {
+		return applyPolicy(config.overloadPolicy, ADMIT_REASON_BACKEND, c, nowMs, reason);
+	}
+	if (config.maxCallsPerHour) {
+		refillBucket(nowMs);
+		if (bucketMilli < MILLI) {
+			return applyPolicy(config.overloadPolicy, ADMIT_REASON_RATE, c, nowMs, reason);
+		}
+		bucketMilli -= MILLI;
+	}
+	if (c) c->queued = false;
+	++stats.accepted;
+	return ADMIT_ACCEPT;
+}
+
+void admissionTokenIssued(const char *number, uint32_t nowMs) {
+	++stats.tokensIssued;
+	if (!number || !number[0]) return;
+	RecentCaller *c = findCaller(number, nowMs, true);
+	c->issued = true;
+	c->issuedMs = nowMs;
+}
+
+void admissionBackendResult(bool ok, uint32_t nowMs) {
+	if (ok) {
+		backendFailures = 0;
+		backendShedding = false;
+		return;
+	}
+	if (backendFailures < 255) ++backendFailures;
+	if (config.backendFailLimit && backendFailures >= config.backendFailLimit) {
+		backendShedding = true;
+		backendShedUntilMs = nowMs + config.backendCooldownMs;
+	}
+}
+
+const AdmissionStats &admissionStats() {
+	return stats;
+}
+
+void admissionResetStats() {
+	memset(&stats, 0, sizeof(stats));
+}
+
+const char *admissionReasonName(AdmitReason reason) {
+	switch (reason) {
+		case ADMIT_REASON_DUPLICATE: return "duplicate";
+		case ADMIT_REASON_STORM: return "storm";
+		case ADMIT_REASON_RATE: return "rate";
+		case ADMIT_REASON_BACKEND: return "backend";
+		default: return "none";
+	}
+}
@@ -0,0 +1,205 @@
+#include "AudioFileSourceConcat.h"
+
+#include <string.h>
+
+namespace {
+
+const uint32_t HEADER_LEN = 44;
+
+uint32_t le32(const uint8_t *p) {
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+uint16_t le16(const uint8_t *p) {
+	return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+void put32(uint8_t *p, uint32_t v) {
+	p[0] = v; p[1] = v >> 8; p[2] = v >> 16; p[3] = v >> 24;
+}
+
+void put16(uint8_t *p, uint16_t v) {
+	p[0] = v; p[1] = v >> 8;
+}
+
+bool readExact(AudioFileSource *src, uint8_t *buf, uint32_t len) {
+	return src->read(buf, len) == len;
+}
+
+} // namespace
+
+AudioFileSourceConcat::AudioFileSourceConcat(Opener opener) : opener(opener) {
+	memset(header, 0, sizeof(header));
+}
+
+AudioFileSourceConcat::~AudioFileSourceConcat() {
+	close();
+}
+
+bool AudioFileSourceConcat::add(const char *path) {
+	if (count >= MAX_SEGMENTS || strlen(path) >= PROMPT_NAME_LEN) return false;
+	AudioFileSource *src = opener(path);
+	if (!src) return false;
+	bool ok = false;
+	uint8_t buf[16];
+	uint16_t fmt = 0, ch = 0, bits = 0;
+	uint32_t rate = 0;
+	if (src->isOpen() && readExact(src, buf, 12) && memcmp(buf, "RIFF", 4) == 0 && memcmp(buf + 8, "WAVE", 4) == 0) {
+		uint32_t at = 12;
+		uint32_t size = src->getSize();
+		while (at + 8 <= size && readExact(src, buf, 8)) {
+			uint32_t chunk = le32(buf + 4);
+			uint32_t consumed = 0;
+			at += 8;
+			if (memcmp(buf, "fmt ", 4) == 0 && chunk >= 16) {
+				if (!readExact(src, buf, 16)) break;
+				consumed = 16;
+				fmt = le16(buf);
+				ch = le16(buf + 2);
+				rate = le32(buf + 4);
+				bits = le16(buf + 14);
+			} else if (memcmp(buf, "data", 4) == 0) {
+				if (fmt != 1 || ch == 0 || (bits != 8 && bits != 16)) break;
+				if (count > 0 && (ch != channels || rate != sampleRate || bits != bitsPerSample)) break;
+				uint32_t len = chunk;
+				if (len > size - at) len = size - at;
+				// Keep every segment whole frames so channels/bytes never slip
+				uint32_t frame = ch * (bits / 8);
+				len -= len % frame;
+				Segment &s = segments[count];
+				strncpy(s.path, path, sizeof(s.path) - 1);
+				s.path[sizeof(s.path) - 1] = '\0';
+				s.dataOffset = at;
+				s.dataLen = len;
+				channels = ch;
+				sampleRate = rate;
+				bitsPerSample = bits;
+				totalData += len;
+				++count;
+				ok = true;
+				break;
+			}
+			// Skip the rest of this chunk (RIFF chunks are word aligned)
+			uint32_t padded = chunk + (chunk & 1);
+			at += padded;
+			if (consumed != padded && !src->seek(at, SEEK_SET)) break;
+		}
+	}
+	delete src;
+	if (ok) buildHeader();
+	return ok;
+}
+
+void AudioFileSourceConcat::buildHeader() {
+	uint16_t blockAlign = channels * (bitsPerSample / 8);
+	memcpy(header, "RIFF", 4);
+	put32(header + 4, 36 + totalData);
+	memcpy(header + 8, "WAVEfmt ", 8);
+	put32(header + 16, 16);
+	put16(header + 20, 1);
+	put16(header + 22, channels);
+	put32(header + 24, sampleRate);
+	put32(header + 28, sampleRate * blockAlign);
+	put16(header + 32, blockAlign);
+	put16(header + 34, bitsPerSample);
+	memcpy(header + 36, "data", 4);
+	put32(header + 40, totalData);
+}
+
+bool AudioFileSourceConcat::openSegment(int index, AudioFileSource **src) {
+	*src = nullptr;
+	if (index >= count) return false;
+	AudioFileSource *s = opener(segments[index].path);
+	if (!s) return false;
+	if (!s->isOpen() || !s->seek(segments[index].dataOffset, SEEK_SET)) {
+		delete s;
+		return false;
+	}
+	*src = s;
+	return true;
+}
+
+uint32_t AudioFileSourceConcat::read(void *data, uint32_t len) {
+	if (closed || count == 0) return 0;
+	uint8_t *out = (uint8_t *)data;
+	uint32_t done = 0;
+	while (done < len && pos < HEADER_LEN) {
+		out[done++] = header[pos++];
+	}
+	while (done < len) {
+		if (curRemaining == 0) {
+			// Advance to the next segment, using the pre-opened source if any
+			delete cur;
+			cur = nullptr;
+			if (curIndex + 1 >= count) break;
+			++curIndex;
+			if (next) {
+				cur = next;
+				next = nullptr;
+			} else {
+				openSegment(curIndex, &cur);
+			}
+			curRemaining = segments[curIndex].dataLen;
+			openSegment(curIndex + 1, &next);
+		}
+		uint32_t want = curRemaining < len - done ? curRemaining : len - done;
+		if (!cur) {
+			// Unreadable segment: substitute silence so the stream length
+			// advertised in the header still holds.
+			uint8_t fill = bitsPerSample == 8 ? 0x80 : 0x00;
+			memset(out + done, fill, want);
+			done += want;
+			pos += want;
+			curRemaining -= want;
+			continue;
+		}
+		uint32_t got = cur->read(out + done, want);
+		if (got == 0) {
+			// Short file: pad the rest of the segment with silence
+			delete cur;
+			cur = nullptr;
+			continue;
+		}
+		done += got;
+		pos += got;
+		curRemaining -= got;
+	}
+	return done;
+}
+
+bool AudioFileSourceConcat::seek(int32_t newPos, int dir) {
+	// Only forward seeks are supported; the WAV decoder uses them to skip chunks
+	uint32_t target;
+	if (dir == SEEK_SET) target = newPos;
+	else if (dir == SEEK_CUR) target = pos + newPos;
+	else if (dir == SEEK_END) target = getSize() + newPos;
+	else return false;
+	if (target < pos || target > getSize()) return false;
+	uint8_t scratch[64];
+	while (pos < target) {
+		uint32_t n = target - pos < sizeof(scratch) ? target - pos : sizeof(scratch);
+		if (read(scratch, n) != n) return false;
+	}
+	return true;
+}
+
+bool AudioFileSourceConcat::close() {
+	delete cur;
+	delete next;
+	cur = nullptr;
+	next = nullptr;
+	closed = true;
+	return true;
+}
+
+bool AudioFileSourceConcat::isOpen() {
+	return !closed && count > 0;
+}
+
+uint32_t AudioFileSourceConcat::getSize() {
+	return count ? HEADER_LEN + totalData : 0;
+}
+
+uint32_t AudioFileSourceConcat::getPos() {
+	return pos;
+}
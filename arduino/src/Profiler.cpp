@@ -0,0 +1,165 @@
+#include "Profiler.h"
+
+#include <esp_heap_caps.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+namespace {
+
+ProfSite *sites = nullptr;
+// Longest single recording since the last tick; a stall is charged to it
+ProfSite *windowSite = nullptr;
+uint32_t windowMaxUs = 0;
+
+#if PROFILER_ENABLED
+ProfScope *currentScope = nullptr;
+#endif
+
+uint32_t lastTickMs = 0;
+uint32_t stallCount = 0;
+uint32_t unattributedStalls = 0;
+uint32_t stallMaxMs = 0;
+uint64_t stallTotalMs = 0;
+const char *worstStallSite = nullptr;
+
+uint32_t bucketUpperUs(int bucket) {
+	return 128UL << bucket;
+}
+
+int bucketFor(uint32_t us) {
+	int b = 0;
+	uint32_t limit = 128;
+	while (b < PROF_BUCKETS - 1 && us >= limit) {
+		limit <<= 1;
+		++b;
+	}
+	return b;
+}
+
+// Upper bound of the bucket holding the given percentile
+uint32_t percentileUs(const ProfSite *s, uint32_t pct) {
+	uint32_t want = (s->count * pct + 99) / 100;
+	uint32_t seen = 0;
+	for (int b = 0; b < PROF_BUCKETS; ++b) {
+		seen += s->buckets[b];
+		if (seen >= want) return b == PROF_BUCKETS - 1 || bucketUpperUs(b) > s->maxUs ? s->maxUs : bucketUpperUs(b);
+	}
+	return s->maxUs;
+}
+
+} // namespace
+
+#if PROFILER_ENABLED
+ProfScope::ProfScope(ProfSite *site) : site(site), parent(currentScope), start(micros()), childUs(0) {
+	currentScope = this;
+}
+
+ProfScope::~ProfScope() {
+	uint32_t us = micros() - start;
+	currentScope = parent;
+	if (parent) parent->childUs += us;
+	profRecord(site, us, us > childUs ? us - childUs : 0);
+}
+#endif
+
+void profRecord(ProfSite *site, uint32_t us, uint32_t selfUs) {
+	if (!site->registered) {
+		site->registered = true;
+		site->next = sites;
+		sites = site;
+	}
+	++site->count;
+	site->totalUs += selfUs;
+	if (us > site->maxUs) site->maxUs = us;
+	++site->buckets[bucketFor(us)];
+	if (us >= windowMaxUs) {
+		windowMaxUs = us;
+		windowSite = site;
+	}
+}
+
+void profLoopTick() {
+#if PROFILER_ENABLED
+	uint32_t now = millis();
+	uint32_t gap = now - lastTickMs;
+	if (lastTickMs != 0 && gap > PROF_STALL_MS) {
+		++stallCount;
+		stallTotalMs += gap;
+		// Blame a site only if it covers at least half the gap; otherwise the
+		// time went to unprofiled code and naming a short call would mislead
+		ProfSite *blamed = windowSite && windowMaxUs / 1000 * 2 >= gap ? windowSite : nullptr;
+		if (blamed) ++blamed->stalls;
+		else ++unattributedStalls;
+		if (gap > stallMaxMs) {
+			stallMaxMs = gap;
+			worstStallSite = blamed ? blamed->name : nullptr;
+		}
+	}
+	lastTickMs = now;
+	windowSite = nullptr;
+	windowMaxUs = 0;
+#endif
+}
+
+void profReport(Print &out, int topN) {
+	out.println("--- profile: top call sites by self time ---");
+	out.println("  total/avg exclude nested scopes, so totals add up to real time;");
+	out.println("  p95/max are wall time per call including nested scopes");
+#if PROFILER_ENABLED
+	// Selection by total time without allocating; site lists are short
+	ProfSite *printed[32];
+	int nPrinted = 0;
+	if (topN > 32) topN = 32;
+	out.println("  total ms   count   avg ms   p95 ms   max ms  stalls  site");
+	while (nPrinted < topN) {
+		ProfSite *best = nullptr;
+		for (ProfSite *s = sites; s; s = s->next) {
+			bool done = false;
+			for (int i = 0; i < nPrinted; ++i) done = done || printed[i] == s;
+			if (!done && s->count && (!best || s->totalUs > best->totalUs)) best = s;
+		}
+		if (!best) break;
+		printed[nPrinted++] = best;
+		char line[80];
+		snprintf(line, sizeof(line), "%9lu %7lu %8lu %8lu %8lu %7lu  ",
+			(unsigned long)(best->totalUs / 1000), (unsigned long)best->count,
+			(unsigned long)(best->totalUs / best->count / 1000),
+			(unsigned long)(percentileUs(best, 95) / 1000), (unsigned long)(best->maxUs / 1000),
+			(unsigned long)best->stalls);
+		out.print(line);
+		out.println(best->name);
+	}
+	out.print("loop stalls > "); out.print(PROF_STALL_MS); out.print(" ms: ");
+	out.print(stallCount);
+	out.print(", total "); out.print((uint32_t)stallTotalMs);
+	out.print(" ms, worst "); out.print(stallMaxMs); out.print(" ms");
+	if (stallMaxMs) { out.print(" in "); out.print(worstStallSite ? worstStallSite : "unprofiled code"); }
+	out.print(", unattributed "); out.println(unattributedStalls);
+#else
+	(void)topN;
+	(void)percentileUs;
+	out.println("profiler disabled (PROFILER_ENABLED=0)");
+#endif
+	out.print("heap free "); out.print(ESP.getFreeHeap());
+	out.print(", min free "); out.print(ESP.getMinFreeHeap());
+	out.print(", largest block "); out.println(heap_caps_get_largest_free_block(MALLOC_CAP_8BIT));
+	out.print("loop task stack high-water "); out.print(uxTaskGetStackHighWaterMark(nullptr)); out.println(" bytes free");
+}
+
+void profReset() {
+	for (ProfSite *s = sites; s; s = s->next) {
+		s->count = 0;
+		s->totalUs = 0;
+		s->maxUs = 0;
+		s->stalls = 0;
+		memset(s->buckets, 0, sizeof(s->buckets));
+	}
+	windowSite = nullptr;
+	windowMaxUs = 0;
+	lastTickMs = 0;
+	stallCount = 0;
+	unattributedStalls = 0;
+	stallMaxMs = 0;
+	stallTotalMs = 0;
+	worstStallSite = nullptr;
+}
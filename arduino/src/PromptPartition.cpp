@@ -0,0 +1,160 @@
+#include "PromptPartition.h"
+
+#include <string.h>
+
+#ifdef ARDUINO
+#include <esp_partition.h>
+#include <esp_idf_version.h>
+#else
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const uint32_t HEADER_SIZE = 16;
+const uint32_t ENTRY_SIZE = PROMPT_NAME_LEN + 8;
+
+const uint8_t *imageBase = nullptr;
+uint32_t imageSize = 0;
+uint32_t entryCount = 0;
+
+#ifdef ARDUINO
+#if ESP_IDF_VERSION_MAJOR >= 5
+esp_partition_mmap_handle_t mapHandle = 0;
+#define PROMPT_MMAP_DATA ESP_PARTITION_MMAP_DATA
+#else
+spi_flash_mmap_handle_t mapHandle = 0;
+#define PROMPT_MMAP_DATA SPI_FLASH_MMAP_DATA
+#endif
+#else
+size_t mappedLen = 0;
+#endif
+
+uint32_t readU32(const uint8_t *p) {
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+const uint8_t *entryAt(uint32_t index) {
+	return imageBase + HEADER_SIZE + index * ENTRY_SIZE;
+}
+
+// Check header and every entry against the mapped length so lookups never
+// hand out pointers past the end of the image.
+bool validateImage(const uint8_t *base, uint32_t mappedLen) {
+	if (mappedLen < HEADER_SIZE || memcmp(base, PROMPT_MAGIC, 4) != 0) return false;
+	uint32_t count = readU32(base + 4);
+	uint32_t size = readU32(base + 8);
+	if (size > mappedLen) return false;
+	if (count > (size - HEADER_SIZE) / ENTRY_SIZE) return false;
+	for (uint32_t i = 0; i < count; ++i) {
+		const uint8_t *e = base + HEADER_SIZE + i * ENTRY_SIZE;
+		if (memchr(e, '\0', PROMPT_NAME_LEN) == nullptr) return false;
+		uint32_t off = readU32(e + PROMPT_NAME_LEN);
+		uint32_t len = readU32(e + PROMPT_NAME_LEN + 4);
+		if (off > size || len > size - off) return false;
+	}
+	imageBase = base;
+	imageSize = size;
+	entryCount = count;
+	return true;
+}
+
+} // namespace
+
+#ifdef ARDUINO
+bool promptPartitionBegin() {
+	if (imageBase) return true;
+	const esp_partition_t *part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+		(esp_partition_subtype_t)PROMPT_PARTITION_SUBTYPE, PROMPT_PARTITION_LABEL);
+	if (!part) return false;
+	// Read the header through the flash API first so only the used part of the
+	// partition is mapped; the data MMU window is shared with the app's rodata.
+	uint8_t header[HEADER_SIZE];
+	if (esp_partition_read(part, 0, header, sizeof(header)) != ESP_OK) return false;
+	if (memcmp(header, PROMPT_MAGIC, 4) != 0) return false;
+	uint32_t size = readU32(header + 8);
+	if (size < HEADER_SIZE || size > part->size) return false;
+	const void *ptr = nullptr;
+	if (esp_partition_mmap(part, 0, size, PROMPT_MMAP_DATA, &ptr, &mapHandle) != ESP_OK) return false;
+	if (!validateImage((const uint8_t *)ptr, size)) {
+		promptPartitionEnd();
+		return false;
+	}
+	return true;
+}
+
+void promptPartitionEnd() {
+#if ESP_IDF_VERSION_MAJOR >= 5
+	if (mapHandle) esp_partition_munmap(mapHandle);
+#else
+	if (mapHandle) spi_flash_munmap(mapHandle);
+#endif
+	mapHandle = 0;
+	imageBase = nullptr;
+	imageSize = 0;
+	entryCount = 0;
+}
+#else
+bool promptPartitionBegin() {
+	const char *path = getenv("PROMPTS_IMAGE");
+	return promptPartitionBegin(path ? path : "prompts.bin");
+}
+
+bool promptPartitionBegin(const char *imagePath) {
+	if (imageBase) return true;
+	int fd = open(imagePath, O_RDONLY);
+	if (fd < 0) return false;
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size < (off_t)HEADER_SIZE || st.st_size > 0xFFFFFFFFLL) {
+		close(fd);
+		return false;
+	}
+	void *ptr = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (ptr == MAP_FAILED) return false;
+	mappedLen = (size_t)st.st_size;
+	if (!validateImage((const uint8_t *)ptr, (uint32_t)st.st_size)) {
+		munmap(ptr, mappedLen);
+		mappedLen = 0;
+		return false;
+	}
+	return true;
+}
+
+void promptPartitionEnd() {
+	if (imageBase) munmap((void *)imageBase, mappedLen);
+	mappedLen = 0;
+	imageBase = nullptr;
+	imageSize = 0;
+	entryCount = 0;
+}
+#endif
+
+bool promptPartitionReady() {
+	return imageBase != nullptr;
+}
+
+bool promptLookup(const char *path, const uint8_t **data, uint32_t *len) {
+	if (!imageBase || !path) return false;
+	for (uint32_t i = 0; i < entryCount; ++i) {
+		const uint8_t *e = entryAt(i);
+		if (strcmp((const char *)e, path) != 0) continue;
+		*data = imageBase + readU32(e + PROMPT_NAME_LEN);
+		*len = readU32(e + PROMPT_NAME_LEN + 4);
+		return true;
+	}
+	return false;
+}
+
+uint32_t promptCount() {
+	return entryCount;
+}
+
+const char *promptName(uint32_t index) {
+	if (index >= entryCount) return nullptr;
+	return (const char *)entryAt(index);
+}
@@ -6,12 +6,17 @@
 #include <Adafruit_SSD1306.h>
 // Audio I2S + WAV support
 #include <AudioFileSourceSD.h>
+#include <AudioFileSourcePROGMEM.h>
 #include <AudioGeneratorWAV.h>
 #include <AudioOutputI2S.h>
 // WiFi + HTTP
 #include <WiFi.h>
 #include <HTTPClient.h>
 #include <time.h>
+#include "PromptPartition.h"
+#include "AudioFileSourceConcat.h"
+#include "Admission.h"
+#include "Profiler.h"
 
 // ------------------- SIM800 Setup -------------------
 HardwareSerial sim800(1);
@@ -20,6 +25,10 @@ HardwareSerial sim800(1);
 #define SIM800_RESET 14
 #define SIM800_POWER 12
 #define SIM800_BAUD 115200
+// RING/+CLIP lines seen by sim800WaitFor while a background SMS is being
+// sent; sim800ReadLine hands them out before reading the UART again
+String sim800Stash;
+bool sim800StashUrcs = false;
 
 // ------------------- Sd card Setup -------------------
 #define SD_CS 5     // SD card chip select
@@ -40,13 +49,14 @@ Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, -1);
 
 // Audio objects
 AudioGeneratorWAV *wav = nullptr;
-AudioFileSourceSD *file = nullptr;
+AudioFileSource *file = nullptr;
 AudioOutputI2S *out = nullptr;
 
 // Helpers
 // Forward declarations
 String captureDTMF(uint32_t timeoutMs, const String &caller);
-char playServiceSequence(const String &caller, const String &id);
+// ended (optional) is set when the caller hangs up during the sequence
+char playServiceSequence(const String &caller, const String &id, bool *ended = nullptr);
 void waitForCallThenAnswerAndPlay();
 
 struct TokenResponse {
@@ -60,6 +70,7 @@ struct TokenResponse {
 
 TokenResponse sendCallJson(const String &phone, const String &id, const String &service);
 void sendSmsToken(const String &phone, const TokenResponse &resp);
+bool speakToken(const String &caller, const TokenResponse &resp);
 void logCallToSD(const TokenResponse &resp, const String &phone);
 void sim800Send(const char *cmd);
 bool sim800WaitFor(const char *token, unsigned long timeoutMs = 5000);
@@ -72,9 +83,25 @@ const char* WIFI_SSID = "SLT-4G-2.4_1C6F08"; // e.g. "MyWiFi"
 const char* WIFI_PASS = "EF4382AE"; // e.g. "password"
 const char* SERVER_URL = "http://192.168.1.100:5000/calls"; // change to your server (do NOT use "localhost" from ESP)
 
+// Token delivery: request the token while the call is still up and speak it
+// back from digit/letter/phrase prompts, then SMS according to SMS_MODE.
+const bool SPEAK_TOKEN_ON_CALL = true;
+enum SmsMode {
+	SMS_ALWAYS,         // SMS every token, spoken or not
+	SMS_IF_NOT_SPOKEN,  // skip the SMS when the caller heard the token
+	SMS_DEFERRED        // spoken tokens are SMSed later while the line is idle
+};
+const SmsMode SMS_MODE = SMS_DEFERRED;
+
+// Admission control for incoming calls (windows, limits and policies in Admission.h)
+AdmissionConfig admissionConfig;
+// HTTP status of the last POST /calls, used to detect a struggling backend
+int lastCallHttpCode = 0;
+
 void ensureWiFiConnected() {
 	if (!WIFI_SSID || strlen(WIFI_SSID) == 0) return; // not configured
 	if (WiFi.status() == WL_CONNECTED) return;
+	PROF_SCOPE("wifi.connect");
 	WiFi.mode(WIFI_STA);
 	WiFi.begin(WIFI_SSID, WIFI_PASS);
 	unsigned long start = millis();
@@ -135,6 +162,7 @@ void refreshDateTime(String &dateStr, String &timeStr) {
 }
 
 TokenResponse sendCallJson(const String &phone, const String &id, const String &service) {
+	lastCallHttpCode = 0;
 	if (!WIFI_SSID || strlen(WIFI_SSID) == 0) {
 		oledPrint("WiFi not configured");
 		return {};
@@ -172,13 +200,14 @@ TokenResponse sendCallJson(const String &phone, const String &id, const String &
 	http.addHeader("Content-Type", "application/json");
 	Serial.println("POST /calls payload:");
 	Serial.println(payload);
-	int httpCode = http.POST(payload);
+	int httpCode = PROF_CALL("http.post", http.POST(payload));
+	lastCallHttpCode = httpCode;
 	TokenResponse respOut;
 	respOut.userid = id;
 	respOut.date = date;
 	respOut.time = timev;
 	if (httpCode > 0) {
-		String resp = http.getString();
+		String resp = PROF_CALL("http.getString", http.getString());
 		Serial.print("Response ("); Serial.print(httpCode); Serial.println("):");
 		Serial.println(resp);
 		auto extractField = [&](const char *field) {
@@ -217,8 +246,45 @@ TokenResponse sendCallJson(const String &phone, const String &id, const String &
 	return respOut;
 }
 
+// sendCallJson plus admission bookkeeping: backend health and issued tokens
+TokenResponse requestToken(const String &phone, const String &id, const String &service) {
+	TokenResponse resp = sendCallJson(phone, id, service);
+	// With WiFi deliberately off there is no backend to judge; otherwise
+	// 4xx (e.g. bank closed) is an answer, not an overloaded backend
+	bool backendConfigured = WIFI_SSID && strlen(WIFI_SSID) > 0;
+	if (backendConfigured) admissionBackendResult(lastCallHttpCode > 0 && lastCallHttpCode < 500, millis());
+	if (resp.token.length()) admissionTokenIssued(phone.c_str(), millis());
+	return resp;
+}
+
+void printAdmissionStats() {
+	const AdmissionStats &st = admissionStats();
+	Serial.println("Admission stats:");
+	Serial.printf("  accepted        %u\n", (unsigned)st.accepted);
+	Serial.printf("  rejected dup    %u\n", (unsigned)st.rejectedDuplicate);
+	Serial.printf("  rejected storm  %u\n", (unsigned)st.rejectedStorm);
+	Serial.printf("  rejected rate   %u\n", (unsigned)st.rejectedRate);
+	Serial.printf("  rejected backend %u\n", (unsigned)st.rejectedBackend);
+	Serial.printf("  prompted        %u\n", (unsigned)st.prompted);
+	Serial.printf("  queued          %u (timeouts %u)\n", (unsigned)st.queued, (unsigned)st.queueTimeouts);
+	Serial.printf("  tokens issued   %u\n", (unsigned)st.tokensIssued);
+	if (!WIFI_SSID || strlen(WIFI_SSID) == 0) Serial.println("  backend         not configured (WiFi off)");
+}
+
+// Single-character commands on the USB serial console while idle
+void handleSerialCommand() {
+	while (Serial.available()) {
+		char c = Serial.read();
+		if (c == 's') printAdmissionStats();
+		else if (c == 'r') { admissionResetStats(); Serial.println("Admission stats reset"); }
+		else if (c == 'p') profReport(Serial, 10);
+		else if (c == 'z') { profReset(); Serial.println("Profile reset"); }
+	}
+}
+
 void sendSmsToken(const String &phone, const TokenResponse &resp) {
 	if (phone.length() == 0 || resp.token.length() == 0) return;
+	PROF_SCOPE("sms.send");
 	String msg = "Thank you for using queue managment system!\n";
 	msg += "Token  - " + resp.token + "\n";
 	msg += "ID - " + resp.userid + "\n";
@@ -226,20 +292,58 @@ void sendSmsToken(const String &phone, const TokenResponse &resp) {
 	msg += "Date - " + resp.date;
 	// Basic SMS send over SIM800
 	sim800Send("AT+CMGF=1");
-	sim800WaitFor("OK", 2000);
+	PROF_CALL("sim800.wait.cmgf", sim800WaitFor("OK", 2000));
 	String cmd = String("AT+CMGS=\"") + phone + "\"";
 	sim800Send(cmd.c_str());
-	sim800WaitFor(">", 2000);
+	PROF_CALL("sim800.wait.cmgs_prompt", sim800WaitFor(">", 2000));
 	sim800.print(msg);
 	sim800.write(26); // Ctrl+Z
-	sim800WaitFor("OK", 5000);
+	PROF_CALL("sim800.wait.cmgs", sim800WaitFor("OK", 5000));
+}
+
+// Spoken tokens waiting for their SMS (SMS_DEFERRED), sent between calls
+struct PendingSms {
+	String phone;
+	TokenResponse resp;
+};
+const int PENDING_SMS_MAX = 4;
+PendingSms pendingSms[PENDING_SMS_MAX];
+int pendingSmsCount = 0;
+
+void deliverSmsToken(const String &phone, const TokenResponse &resp, bool spoken) {
+	if (!spoken || SMS_MODE == SMS_ALWAYS) {
+		sendSmsToken(phone, resp);
+		return;
+	}
+	if (SMS_MODE == SMS_IF_NOT_SPOKEN) return;
+	if (pendingSmsCount == PENDING_SMS_MAX) {
+		// Queue full: send the oldest now rather than drop it
+		sendSmsToken(pendingSms[0].phone, pendingSms[0].resp);
+		for (int i = 1; i < pendingSmsCount; ++i) pendingSms[i - 1] = pendingSms[i];
+		--pendingSmsCount;
+	}
+	pendingSms[pendingSmsCount].phone = phone;
+	pendingSms[pendingSmsCount].resp = resp;
+	++pendingSmsCount;
+}
+
+// Send one queued SMS; call only while no call is in progress
+bool flushPendingSms() {
+	if (pendingSmsCount == 0) return false;
+	// Keep any incoming call announced mid-send for the idle loop
+	sim800StashUrcs = true;
+	sendSmsToken(pendingSms[0].phone, pendingSms[0].resp);
+	sim800StashUrcs = false;
+	for (int i = 1; i < pendingSmsCount; ++i) pendingSms[i - 1] = pendingSms[i];
+	--pendingSmsCount;
+	return true;
 }
 
 void logCallToSD(const TokenResponse &resp, const String &phone) {
 	if (resp.date.length() == 0) return;
 	SD.mkdir("/call_log");
 	String fname = String("/call_log/") + resp.date + ".txt";
-	File f = SD.open(fname, FILE_APPEND);
+	File f = PROF_CALL("sd.open.calllog", SD.open(fname, FILE_APPEND));
 	if (!f) {
 		Serial.println("Failed to open call log file");
 		return;
@@ -282,7 +386,7 @@ void oledPrint(const String &line1, const String &line2, const String &line3, co
 		display.setCursor(0, 36);
 		display.println(line4);
 	}
-	display.display();
+	PROF_CALL("oled.display", display.display());
 }
 
 // Always keep caller number on first row
@@ -295,7 +399,7 @@ bool waitForSD(unsigned long timeoutMs = 10000) {
 	SPI.begin(SD_SCK, SD_MISO, SD_MOSI, SD_CS);
 	unsigned long start = millis();
 	while (millis() - start < timeoutMs) {
-		if (SD.begin(SD_CS)) {
+		if (PROF_CALL("sd.begin", SD.begin(SD_CS))) {
 			oledPrint("SD OK", "Card ready");
 			return true;
 		}
@@ -326,10 +430,21 @@ void sim800Send(const char *cmd) {
 bool sim800WaitFor(const char *token, unsigned long timeoutMs) {
 	unsigned long start = millis();
 	String buf;
+	String line;
 	while (millis() - start < timeoutMs) {
 		while (sim800.available()) {
 			char c = sim800.read();
 			buf += c;
+			if (sim800StashUrcs) {
+				if (c == '\n') {
+					if ((line.indexOf("RING") != -1 || line.indexOf("+CLIP:") != -1) && sim800Stash.length() < 256) {
+						sim800Stash += line + "\n";
+					}
+					line = "";
+				} else if (c != '\r') {
+					line += c;
+				}
+			}
 			if (buf.indexOf(token) != -1) return true;
 		}
 	}
@@ -337,6 +452,12 @@ bool sim800WaitFor(const char *token, unsigned long timeoutMs) {
 }
 
 String sim800ReadLine(unsigned long timeoutMs = 2000) {
+	if (sim800Stash.length()) {
+		int nl = sim800Stash.indexOf('\n');
+		String stashed = sim800Stash.substring(0, nl);
+		sim800Stash.remove(0, nl + 1);
+		return stashed;
+	}
 	unsigned long start = millis();
 	String line;
 	while (millis() - start < timeoutMs) {
@@ -430,28 +551,107 @@ String getCarrier() {
 	return String("Unknown");
 }
 
-void playWav(const char *path) {
+// Prefer the memory-mapped prompts partition; fall back to the SD card
+AudioFileSource *openPrompt(const char *path) {
+	const uint8_t *data;
+	uint32_t len;
+	if (promptLookup(path, &data, &len)) return new AudioFileSourcePROGMEM(data, len);
+	return new AudioFileSourceSD(path);
+}
+
+// Start decoding src, taking ownership of it
+bool playSource(AudioFileSource *src) {
 	if (wav && wav->isRunning()) wav->stop();
 	if (file) { delete file; file = nullptr; }
-	file = new AudioFileSourceSD(path);
-	if (!file || !file->isOpen()) {
-		oledPrint("WAV open fail", path);
-		return;
-	}
+	file = src;
+	if (!file || !file->isOpen()) return false;
 	if (!wav) wav = new AudioGeneratorWAV();
 	if (!out) initAudioI2S();
-	wav->begin(file, out);
+	return wav->begin(file, out);
+}
+
+void playWav(const char *path) {
+	if (!playSource(PROF_CALL("prompt.open", openPrompt(path)))) {
+		oledPrint("WAV open fail", path);
+	}
+}
+
+// Append the prompt for one token/counter character; '-' and spaces are silent
+bool addCharPrompt(AudioFileSourceConcat *seq, char c) {
+	char fname[48];
+	if (c >= '0' && c <= '9') {
+		snprintf(fname, sizeof(fname), "/audio_files/digits/%c.wav", c);
+	} else if ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z')) {
+		snprintf(fname, sizeof(fname), "/audio_files/letters/%c.wav", toupper(c));
+	} else {
+		return true;
+	}
+	return seq->add(fname);
+}
+
+// Counter names are free text; a recorded /audio_files/counters/<name>.wav
+// (lowercase, non-alphanumerics as '_') is preferred over spelling it out
+bool addCounterPrompt(AudioFileSourceConcat *seq, const String &name) {
+	String slug;
+	for (unsigned int i = 0; i < name.length() && slug.length() < 24; ++i) {
+		char c = name[i];
+		slug += isalnum((unsigned char)c) ? (char)tolower(c) : '_';
+	}
+	String path = String("/audio_files/counters/") + slug + ".wav";
+	if (seq->add(path.c_str())) return true;
+	for (unsigned int i = 0; i < name.length(); ++i) {
+		if (!addCharPrompt(seq, name[i])) return false;
+	}
+	return true;
+}
+
+// Speak "your token is T, 2, 0, ... at counter ..." as one gapless stream.
+// Returns true only if the whole readback played before the caller hung up.
+bool speakToken(const String &caller, const TokenResponse &resp) {
+	AudioFileSourceConcat *seq = new AudioFileSourceConcat(openPrompt);
+	bool ok;
+	{
+		// Probing every segment header is silence on the line; keep it visible
+		PROF_SCOPE("readback.probe");
+		ok = seq->add("/audio_files/phrases/token_is.wav");
+		for (unsigned int i = 0; ok && i < resp.token.length(); ++i) ok = addCharPrompt(seq, resp.token[i]);
+		if (ok && resp.countername.length()) {
+			ok = seq->add("/audio_files/phrases/at_counter.wav") && addCounterPrompt(seq, resp.countername);
+		}
+	}
+	// A partial readback is worse than none; leave it to the SMS
+	if (!ok) {
+		const char *why = seq->full() ? "too many prompts" : "prompt missing";
+		Serial.print("Token readback skipped: "); Serial.println(why);
+		oledStatus(caller, String("Token: ") + resp.token, "Readback skipped", why);
+		delete seq;
+		return false;
+	}
+	oledStatus(caller, String("Token: ") + resp.token, "Speaking token");
+	if (!playSource(seq)) return false;
+	unsigned long lastRun = millis();
+	while (true) {
+		PROF_LOOP_TICK();
+		if (wav && wav->isRunning()) { wav->loop(); lastRun = millis(); }
+		if (sim800.available()) {
+			String l = sim800ReadLine(200);
+			if (l.indexOf("NO CARRIER") != -1 || l.indexOf("BUSY") != -1) return false;
+		}
+		if (!(wav && wav->isRunning()) && millis() - lastRun > 500) break;
+	}
+	return true;
 }
 
 // Capture 12-digit DTMF code followed by '#'. Shows progress on OLED.
 String captureDTMF(uint32_t timeoutMs, const String &caller) {
 	sim800Send("AT+DDET=1");
-	sim800WaitFor("OK", 1000);
+	PROF_CALL("sim800.wait.ddet", sim800WaitFor("OK", 1000));
 	String code = "";
 	bool hashPressed = false;
 	unsigned long start = millis();
 	oledStatus(caller, String("id: ") + code, "Press # to confirm");
 	while (millis() - start < timeoutMs) {
+		PROF_LOOP_TICK();
 		if (sim800.available()) {
 			String line = sim800ReadLine(500);
 			if (line.indexOf("+DTMF:") != -1) {
@@ -479,16 +679,17 @@ String captureDTMF(uint32_t timeoutMs, const String &caller) {
 		delay(20);
 	}
 	sim800Send("AT+DDET=0");
-	sim800WaitFor("OK", 500);
+	PROF_CALL("sim800.wait.ddet_off", sim800WaitFor("OK", 500));
 	if (hashPressed && code.length() == 12) return code;
 	return String("");
 }
 
 // After # entered, play sv01..sv09 and allow single-digit selection
-char playServiceSequence(const String &caller, const String &id) {
+char playServiceSequence(const String &caller, const String &id, bool *ended) {
+	if (ended) *ended = false;
 	// Enable DTMF detection during playback
 	sim800Send("AT+DDET=1");
-	sim800WaitFor("OK", 1000);
+	PROF_CALL("sim800.wait.ddet", sim800WaitFor("OK", 1000));
 	char selected = '\0';
 	for (int i = 1; i <= 9; ++i) {
 		char fname[64];
@@ -499,6 +700,7 @@ char playServiceSequence(const String &caller, const String &id) {
 		unsigned long lastRun = millis();
 		bool callEnded = false;
 		while (true) {
+			PROF_LOOP_TICK();
 			if (wav && wav->isRunning()) { wav->loop(); lastRun = millis(); }
 			if (sim800.available()) {
 				String l = sim800ReadLine(200);
@@ -527,7 +729,10 @@ char playServiceSequence(const String &caller, const String &id) {
 		}
 		// If user selected a digit, end sequence early
 		if (selected >= '0' && selected <= '9') break;
-		if (callEnded) break;
+		if (callEnded) {
+			if (ended) *ended = true;
+			return selected;
+		}
 	}
 	// If user selected a digit during sv01..sv09
 		if (selected >= '0' && selected <= '9') {
@@ -536,6 +741,7 @@ char playServiceSequence(const String &caller, const String &id) {
 		unsigned long lastRun = millis();
 		bool callEnded = false;
 		while (true) {
+			PROF_LOOP_TICK();
 			if (wav && wav->isRunning()) { wav->loop(); lastRun = millis(); }
 			if (sim800.available()) {
 				String l = sim800ReadLine(200);
@@ -545,6 +751,7 @@ char playServiceSequence(const String &caller, const String &id) {
 		}
 			// If call already ended from remote side, just return selected
 			if (callEnded) {
+				if (ended) *ended = true;
 				return selected;
 			}
 			// finished playing confirmation - return selected to caller to handle hangup/json
@@ -556,6 +763,7 @@ char playServiceSequence(const String &caller, const String &id) {
 		selected = '\0';
 		bool callEnded = false;
 		while (true) {
+			PROF_LOOP_TICK();
 			if (sim800.available()) {
 				String l = sim800ReadLine(200);
 				if (l.indexOf("+DTMF:") != -1) {
@@ -574,10 +782,13 @@ char playServiceSequence(const String &caller, const String &id) {
 			if (millis() - waitStart > 10000) break; // 10 second timeout
 		}
 		// Act on selection
-		if (callEnded) return selected;
+		if (callEnded) {
+			if (ended) *ended = true;
+			return selected;
+		}
 		if (selected == '0') {
 			// Repeat sv01..sv09 sequence
-			selected = playServiceSequence(caller, id);
+			selected = playServiceSequence(caller, id, ended);
 			return selected;
 		}
 		if (selected >= '1' && selected <= '8') {
@@ -585,10 +796,14 @@ char playServiceSequence(const String &caller, const String &id) {
 			playWav("/audio_files/2.wav");
 			unsigned long lastRun = millis();
 			while (true) {
+				PROF_LOOP_TICK();
 				if (wav && wav->isRunning()) { wav->loop(); lastRun = millis(); }
 				if (sim800.available()) {
 					String l = sim800ReadLine(200);
-					if (l.indexOf("NO CARRIER") != -1 || l.indexOf("BUSY") != -1) { break; }
+					if (l.indexOf("NO CARRIER") != -1 || l.indexOf("BUSY") != -1) {
+						if (ended) *ended = true;
+						break;
+					}
 				}
 				if (!(wav && wav->isRunning()) && millis() - lastRun > 500) break;
 			}
@@ -602,19 +817,37 @@ char playServiceSequence(const String &caller, const String &id) {
 	return selected;
 }
 
+// Idle screen with admission counters; redrawn whenever a call is turned away
+void oledIdle() {
+	const AdmissionStats &st = admissionStats();
+	uint32_t rejected = st.rejectedDuplicate + st.rejectedStorm + st.rejectedRate + st.rejectedBackend;
+	oledPrint("Waiting for call...", String("Accepted: ") + st.accepted, String("Rejected: ") + rejected);
+}
+
 // Main call handling: answer, play 1.wav, capture ID, then services
 void waitForCallThenAnswerAndPlay() {
 	// Update date/time before handling calls
 	String _date, _time;
 	refreshDateTime(_date, _time);
-	oledPrint("Waiting for call...");
+	oledIdle();
 	// Enable caller ID
-	sim800Send("AT+CLIP=1"); sim800WaitFor("OK", 1000);
+	sim800Send("AT+CLIP=1"); PROF_CALL("sim800.wait.clip", sim800WaitFor("OK", 1000));
 	String caller = "";
+	unsigned long lastActivity = millis();
 	while (true) {
-		if (sim800.available()) {
+		PROF_LOOP_TICK();
+		// Deferred SMS go out only once the modem has been quiet for longer than
+		// the RING repeat interval, so a ringing call isn't kept waiting
+		if (pendingSmsCount > 0 && !sim800.available() && sim800Stash.length() == 0 && millis() - lastActivity > 6000) {
+			flushPendingSms();
+			lastActivity = millis();
+		}
+		handleSerialCommand();
+		if (sim800Stash.length() || sim800.available()) {
+			lastActivity = millis();
 			String line = sim800ReadLine(1000);
 			if (line.indexOf("RING") != -1) {
+				caller = "";
 				// Next line typically: +CLIP: "<number>",...
 				unsigned long t0 = millis();
 				while (millis() - t0 < 2000) {
@@ -626,11 +859,49 @@ void waitForCallThenAnswerAndPlay() {
 						break;
 					}
 				}
+				AdmitReason why;
+				AdmitDecision admit = admissionCheck(caller.c_str(), millis(), &why);
+				if (admit == ADMIT_QUEUE) {
+					// Leave it ringing; the next RING re-checks for capacity
+					oledPrint("Incoming call", "Queued", admissionReasonName(why));
+					continue;
+				}
+				if (admit == ADMIT_REJECT) {
+					// Fast reject: never answered, no greeting played
+					sim800Send("ATH");
+					PROF_CALL("sim800.wait.reject", sim800WaitFor("OK", 1000));
+					if (why != ADMIT_REASON_NONE) {
+						Serial.print("Rejected "); Serial.print(caller); Serial.print(": "); Serial.println(admissionReasonName(why));
+						oledIdle();
+					}
+					continue;
+				}
+				if (admit == ADMIT_PROMPT) {
+					// Answer just long enough for a short explanation
+					sim800Send("ATA");
+					PROF_CALL("sim800.wait.ata", sim800WaitFor("OK", 2000));
+					oledStatus(caller, "Not admitted", admissionReasonName(why));
+					playWav(why == ADMIT_REASON_DUPLICATE ? "/audio_files/phrases/already_issued.wav" : "/audio_files/phrases/busy.wav");
+					unsigned long lastRun = millis();
+					while (true) {
+						PROF_LOOP_TICK();
+						if (wav && wav->isRunning()) { wav->loop(); lastRun = millis(); }
+						if (sim800.available()) {
+							String l = sim800ReadLine(200);
+							if (l.indexOf("NO CARRIER") != -1 || l.indexOf("BUSY") != -1) break;
+						}
+						if (!(wav && wav->isRunning()) && millis() - lastRun > 500) break;
+					}
+					sim800Send("ATH");
+					PROF_CALL("sim800.wait.ath", sim800WaitFor("OK", 2000));
+					oledIdle();
+					continue;
+				}
 				oledPrint("Incoming call", "Answering in 2s...");
-				delay(2000);
+				PROF_CALL("delay.answer", delay(2000));
 				// Answer
 				sim800Send("ATA");
-				sim800WaitFor("OK", 2000);
+				PROF_CALL("sim800.wait.ata", sim800WaitFor("OK", 2000));
 				// Play 1.wav and keep number on row1
 				oledStatus(caller, "Playing 1.wav");
 				playWav("/audio_files/1.wav");
@@ -638,6 +909,7 @@ void waitForCallThenAnswerAndPlay() {
 				unsigned long lastRun = millis();
 				bool callEnded = false;
 				while (true) {
+					PROF_LOOP_TICK();
 					if (wav && wav->isRunning()) { wav->loop(); lastRun = millis(); }
 					if (sim800.available()) {
 						String l = sim800ReadLine(200);
@@ -647,11 +919,11 @@ void waitForCallThenAnswerAndPlay() {
 				}
 				if (callEnded) {
 					sim800Send("ATH");
-					sim800WaitFor("OK", 2000);
+					PROF_CALL("sim800.wait.ath", sim800WaitFor("OK", 2000));
 					oledPrint("Call ended");
-					delay(1000);
+					PROF_CALL("delay.call_ended", delay(1000));
 					// Send JSON with no id/service (call dropped early)
-					TokenResponse t = sendCallJson(caller, String(""), String(""));
+					TokenResponse t = requestToken(caller, String(""), String(""));
 					if (t.token.length()) {
 						sendSmsToken(caller, t);
 						logCallToSD(t, caller);
@@ -664,22 +936,32 @@ void waitForCallThenAnswerAndPlay() {
 				// Show final code on row2
 				oledStatus(caller, String("id: ") + code);
 				char sel = '\0';
+				bool hungUp = false;
 				if (code.length() == 12) {
-					sel = playServiceSequence(caller, code);
+					sel = playServiceSequence(caller, code, &hungUp);
+				}
+				String service = (sel >= '0' && sel <= '9') ? String(sel) : String("");
+				TokenResponse resp;
+				bool requested = false;
+				bool spoken = false;
+				// Request the token while the caller is still on the line and read it back;
+				// if they already hung up, the SMS below goes out straight away
+				if (SPEAK_TOKEN_ON_CALL && code.length() == 12 && sel != '\0' && !hungUp) {
+					oledStatus(caller, String("id: ") + code, "Requesting token...");
+					resp = requestToken(caller, code, service);
+					requested = true;
+					if (resp.token.length()) spoken = speakToken(caller, resp);
 				}
 				// Hang up after finishing
 				sim800Send("ATH");
-				sim800WaitFor("OK", 2000);
+				PROF_CALL("sim800.wait.ath", sim800WaitFor("OK", 2000));
 				oledPrint("Call ended");
-				delay(1000);
+				PROF_CALL("delay.call_ended", delay(1000));
 				// Send JSON over WiFi (if configured) and SMS token back to caller
-				{
-					String service = (sel >= '0' && sel <= '9') ? String(sel) : String("");
-					TokenResponse resp = sendCallJson(caller, code, service);
-					if (resp.token.length()) {
-						sendSmsToken(caller, resp);
-						logCallToSD(resp, caller);
-					}
+				if (!requested) resp = requestToken(caller, code, service);
+				if (resp.token.length()) {
+					deliverSmsToken(caller, resp, spoken);
+					logCallToSD(resp, caller);
 				}
 				break;
 			}
@@ -700,7 +982,14 @@ void setup() {
 	display.clearDisplay();
 	display.display();
 
-	// 1) Wait for SD OK
+	admissionBegin(admissionConfig);
+
+	// 1) Map prompts from flash, then wait for SD (prompt fallback + call logs)
+	if (promptPartitionBegin()) {
+		Serial.print("Prompts: flash, "); Serial.print(promptCount()); Serial.println(" files");
+	} else {
+		Serial.println("Prompts: SD");
+	}
 	waitForSD();
 
 	// 2) Init MAX98357A
@@ -723,12 +1012,13 @@ void setup() {
 	String carrier = getCarrier();
 	String ip = (WiFi.status() == WL_CONNECTED) ? WiFi.localIP().toString() : String("WiFi not connected");
 	oledPrint(carrier, ip, dateStr, timeStr);
-	delay(3000);
+	PROF_CALL("delay.splash", delay(3000));
 	display.clearDisplay();
 	display.display();
 }
 
 void loop() {
+	PROF_LOOP_TICK();
 	// 7) Wait for call
 	waitForCallThenAnswerAndPlay();
 	// After handling, small pause